@@ -6,6 +6,7 @@
 
 QT       += core gui
 QT += serialport
+QT += network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -27,11 +28,18 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
         main.cpp \
         mainwindow.cpp \
-    detailsdialog.cpp
+    detailsdialog.cpp \
+    cardeventpublisher.cpp \
+    cardexportwriter.cpp
 
 HEADERS += \
         mainwindow.h \
-    detailsdialog.h
+    detailsdialog.h \
+    cardeventpublisher.h \
+    cardexportwriter.h
+
+# shm_open eski glibc sürümlerinde librt içinde
+unix:!macx: LIBS += -lrt
 
 FORMS += \
         mainwindow.ui \
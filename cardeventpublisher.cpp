@@ -0,0 +1,294 @@
+#include "cardeventpublisher.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDebug>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+static_assert(sizeof(CardEventRecord) == 128, "CardEventRecord sabit 128 bayt olmalı");
+static_assert(sizeof(CardEventRingHeader) == 64, "CardEventRingHeader 64 bayt olmalı");
+
+namespace {
+
+const quint32 RingMagic = 0x43524452; // 'CRDR'
+const quint16 RingVersion = 1;
+const qint64 MaxClientBacklog = 64 * 1024;
+
+// "04 A1 B2" biçimindeki hex metni en fazla maxLen bayta çevirir; "-" boş dizi verir
+quint8 copyHexField(const QString &hex, quint8 *dest, int maxLen)
+{
+    const QByteArray bytes = QByteArray::fromHex(hex.toLatin1());
+    const int len = qMin(bytes.size(), maxLen);
+    std::memcpy(dest, bytes.constData(), len);
+    return static_cast<quint8>(len);
+}
+
+qint64 currentTimestampUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+CardEventPublisher::CardEventPublisher(QObject *parent)
+    : QObject(parent)
+    , shmFd(-1)
+    , shmBase(nullptr)
+    , shmSize(0)
+    , ringHeader(nullptr)
+    , ringRecords(nullptr)
+    , nextIndex(0)
+    , localServer(new QLocalServer(this))
+{
+    connect(localServer, &QLocalServer::newConnection, this, &CardEventPublisher::handleNewConnection);
+}
+
+CardEventPublisher::~CardEventPublisher()
+{
+    stop();
+}
+
+bool CardEventPublisher::start(const QString &name)
+{
+    stop();
+
+    // Başka bir örnek bu adla yayın yapıyorsa onun halkası ve soketi silinmez
+    if (isOwnerAlive(name)) {
+        qDebug() << "Olay yayını başlatılmadı, ad başka bir örnek tarafından kullanılıyor:" << name;
+        return false;
+    }
+
+    bool shmOk = openSharedMemory(name);
+
+    // Sahibi olmayan (önceki bir çökmeden kalan) soket dosyasını temizleyip sunucuyu başlatır.
+    // Kart UID'leri ve blok verileri taşındığından soket yalnızca aynı kullanıcıya açıktır.
+    QLocalServer::removeServer(name);
+    localServer->setSocketOptions(QLocalServer::UserAccessOption);
+    bool socketOk = localServer->listen(name);
+    if (!socketOk)
+        qDebug() << "Olay soketi açılamadı:" << localServer->errorString();
+
+    qDebug() << "Olay yayını başladı. Paylaşımlı bellek:" << shmOk << ", soket:" << socketOk;
+    return shmOk || socketOk;
+}
+
+void CardEventPublisher::stop()
+{
+    for (QLocalSocket *client : clients) {
+        client->disconnect(this);
+        client->abort();
+        client->deleteLater();
+    }
+    clients.clear();
+    if (localServer->isListening())
+        localServer->close();
+    closeSharedMemory();
+}
+
+bool CardEventPublisher::isSharedMemoryActive() const
+{
+    return ringHeader != nullptr;
+}
+
+bool CardEventPublisher::isOwnerAlive(const QString &name)
+{
+    // Soketine bağlanılabiliyorsa sahibi hâlâ çalışıyordur
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    bool alive = probe.waitForConnected(100);
+    probe.abort();
+    return alive;
+}
+
+bool CardEventPublisher::openSharedMemory(const QString &name)
+{
+#ifdef Q_OS_UNIX
+    const QByteArray posixName = "/" + name.toLocal8Bit();
+    const size_t size = sizeof(CardEventRingHeader) + RingCapacity * sizeof(CardEventRecord);
+
+    // Önce O_EXCL ile oluşturmayı dener. Nesne zaten varsa, start() sahibinin yaşamadığını
+    // doğruladığı için bayattır; silinip (boyutu/başlığı farklı olabilir) yeniden oluşturulur.
+    int fd = shm_open(posixName.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        qDebug() << "Bayat paylaşımlı bellek nesnesi temizleniyor:" << posixName;
+        shm_unlink(posixName.constData());
+        fd = shm_open(posixName.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        qDebug() << "shm_open başarısız:" << std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        qDebug() << "ftruncate başarısız:" << std::strerror(errno);
+        ::close(fd);
+        shm_unlink(posixName.constData());
+        return false;
+    }
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        qDebug() << "mmap başarısız:" << std::strerror(errno);
+        ::close(fd);
+        shm_unlink(posixName.constData());
+        return false;
+    }
+
+    // ftruncate belleği sıfırlar; sequence == 0 "boş slot" anlamına gelir
+    ringHeader = static_cast<CardEventRingHeader *>(base);
+    ringRecords = reinterpret_cast<CardEventRecord *>(static_cast<char *>(base) + sizeof(CardEventRingHeader));
+    ringHeader->version = RingVersion;
+    ringHeader->recordSize = sizeof(CardEventRecord);
+    ringHeader->capacity = RingCapacity;
+    // magic en son yazılır; tüketiciler magic'i gördüğünde başlık hazırdır
+    __atomic_store_n(&ringHeader->magic, RingMagic, __ATOMIC_RELEASE);
+
+    shmName = QString::fromLocal8Bit(posixName);
+    shmFd = fd;
+    shmBase = base;
+    shmSize = size;
+    nextIndex = 0;
+    return true;
+#else
+    Q_UNUSED(name);
+    return false;
+#endif
+}
+
+void CardEventPublisher::closeSharedMemory()
+{
+#ifdef Q_OS_UNIX
+    if (!shmBase)
+        return;
+    // Bekleyen tüketiciler eski eşlemede sonsuza dek kalmasın diye kapanış bildirilir;
+    // tüketiciler closed alanını görünce halkayı yeniden açar
+    __atomic_store_n(&ringHeader->closed, 1, __ATOMIC_RELEASE);
+    wakeConsumers();
+    munmap(shmBase, shmSize);
+    ::close(shmFd);
+    shm_unlink(shmName.toLocal8Bit().constData());
+#endif
+    shmName.clear();
+    shmFd = -1;
+    shmBase = nullptr;
+    shmSize = 0;
+    ringHeader = nullptr;
+    ringRecords = nullptr;
+}
+
+void CardEventPublisher::wakeConsumers()
+{
+#ifdef Q_OS_UNIX
+    __atomic_add_fetch(&ringHeader->wakeCounter, 1, __ATOMIC_RELEASE);
+#ifdef Q_OS_LINUX
+    // Paylaşımlı (FUTEX_PRIVATE olmayan) futex: farklı süreçlerdeki bekleyenleri uyandırır
+    syscall(SYS_futex, &ringHeader->wakeCounter, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+#endif
+}
+
+void CardEventPublisher::setCurrentUid(const QString &uid)
+{
+    currentUid = QByteArray::fromHex(uid.toLatin1()).left(static_cast<int>(sizeof(CardEventRecord::uid)));
+}
+
+void CardEventPublisher::publishCardEvent(bool success,
+                                          const QByteArray &raw,
+                                          const QString &type,
+                                          const QString &uid,
+                                          const QString &sak,
+                                          const QString &atq)
+{
+    CardEventRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.kind = CardPoll;
+    record.success = success ? 1 : 0;
+    record.uidLength = copyHexField(uid, record.uid, sizeof(record.uid));
+    record.typeLength = copyHexField(type, record.type, sizeof(record.type));
+    record.sakLength = copyHexField(sak, record.sak, sizeof(record.sak));
+    record.atqLength = copyHexField(atq, record.atq, sizeof(record.atq));
+    record.dataLength = static_cast<quint16>(qMin(raw.size(), static_cast<int>(sizeof(record.data))));
+    std::memcpy(record.data, raw.constData(), record.dataLength);
+    publish(record);
+}
+
+void CardEventPublisher::publishMifareResult(EventKind kind,
+                                             bool success,
+                                             int blockNumber,
+                                             uchar errorCode,
+                                             const QByteArray &data)
+{
+    CardEventRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.kind = kind;
+    record.success = success ? 1 : 0;
+    record.blockNumber = static_cast<quint8>(blockNumber);
+    record.errorCode = errorCode;
+    record.uidLength = static_cast<quint8>(qMin(currentUid.size(), static_cast<int>(sizeof(record.uid))));
+    std::memcpy(record.uid, currentUid.constData(), record.uidLength);
+    record.dataLength = static_cast<quint16>(qMin(data.size(), static_cast<int>(sizeof(record.data))));
+    std::memcpy(record.data, data.constData(), record.dataLength);
+    publish(record);
+}
+
+void CardEventPublisher::publish(CardEventRecord &record)
+{
+    record.timestampUs = currentTimestampUs();
+    const quint64 index = nextIndex++;
+    record.sequence = (index + 1) * 2;
+
+#ifdef Q_OS_UNIX
+    if (ringRecords) {
+        CardEventRecord *slot = &ringRecords[index & (RingCapacity - 1)];
+
+        // Seqlock yazımı: tek değer -> yük -> çift değer. Tüketici iki okuma arasında
+        // farklı sequence görürse kopyasını atar ve tekrar dener.
+        __atomic_store_n(&slot->sequence, record.sequence - 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        std::memcpy(reinterpret_cast<char *>(slot) + offsetof(CardEventRecord, timestampUs),
+                    reinterpret_cast<const char *>(&record) + offsetof(CardEventRecord, timestampUs),
+                    sizeof(CardEventRecord) - offsetof(CardEventRecord, timestampUs));
+        __atomic_store_n(&slot->sequence, record.sequence, __ATOMIC_RELEASE);
+        __atomic_store_n(&ringHeader->writeIndex, index + 1, __ATOMIC_RELEASE);
+        wakeConsumers();
+    }
+#endif
+
+    // Soket istemcilerine aynı sabit boyutlu kayıt gönderilir; okumayan istemcinin
+    // tamponu sınırsız büyümesin diye birikmiş veri fazlaysa o kayıt atlanır
+    for (QLocalSocket *client : clients) {
+        if (client->bytesToWrite() > MaxClientBacklog)
+            continue;
+        client->write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+
+    emit eventPublished(record);
+}
+
+void CardEventPublisher::handleNewConnection()
+{
+    while (QLocalSocket *client = localServer->nextPendingConnection()) {
+        clients.append(client);
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            clients.removeAll(client);
+            client->deleteLater();
+        });
+        qDebug() << "Olay soketine yeni istemci bağlandı. Toplam:" << clients.size();
+    }
+}
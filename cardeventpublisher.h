@@ -0,0 +1,134 @@
+#ifndef CARDEVENTPUBLISHER_H
+#define CARDEVENTPUBLISHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QMetaType>
+
+class QLocalServer;
+class QLocalSocket;
+
+// Halkadaki her olay için sabit boyutlu (128 bayt) kayıt düzeni.
+// Tüketiciler bu yapıyı kendi taraflarında aynen tanımlar; kayıt halkadan yerinde kullanılmaz,
+// aşağıdaki seqlock adımlarıyla yerel bir kopyaya alınıp doğrulandıktan sonra okunur.
+struct CardEventRecord
+{
+    quint64 sequence;     // Seqlock: yazım sürerken tek, tamamlandığında (indeks + 1) * 2
+    qint64  timestampUs;  // Unix epoch'tan itibaren mikrosaniye
+    quint8  kind;         // CardEventPublisher::EventKind
+    quint8  success;      // 1: başarılı, 0: başarısız
+    quint8  blockNumber;  // Blok okuma için blok, kimlik doğrulama için sektör numarası
+    quint8  errorCode;    // Okuyucunun DF 78 ile döndürdüğü hata kodu (yoksa 0)
+    quint8  uidLength;    // CardPoll: okunan UID; MIFARE: son sorguda görülen kartın UID'si (kart yoksa 0)
+    quint8  typeLength;
+    quint8  sakLength;
+    quint8  atqLength;
+    quint16 dataLength;   // data alanındaki geçerli bayt sayısı
+    quint8  reserved[2];
+    quint8  uid[10];
+    quint8  type[4];
+    quint8  sak[2];
+    quint8  atq[4];
+    quint8  data[80];     // Kart olayı için ham yanıt, MIFARE için blok verisi (kırpılmış olabilir)
+};
+
+Q_DECLARE_METATYPE(CardEventRecord)
+
+// Paylaşımlı bellek nesnesinin başındaki 64 baytlık başlık; kayıtlar hemen arkasından gelir.
+struct CardEventRingHeader
+{
+    quint32 magic;        // 'CRDR'
+    quint16 version;
+    quint16 recordSize;   // sizeof(CardEventRecord)
+    quint32 capacity;     // Kayıt sayısı (2'nin kuvveti)
+    quint32 wakeCounter;  // Her yayında artar; tüketiciler bu kelime üzerinde futex ile bekler
+    quint64 writeIndex;   // Şimdiye kadar yayınlanan toplam kayıt sayısı
+    quint32 closed;       // 1: üretici halkayı kapattı, yeni kayıt gelmeyecek
+    quint8  reserved[36];
+};
+
+// Kart olaylarını ve tamamlanan MIFARE sonuçlarını yerel süreçlere yayınlar.
+//
+// Birincil yol POSIX paylaşımlı bellekte tek üreticili / çok tüketicili kilitsiz bir halkadır
+// (/dev/shm/<ad>, yalnızca aynı kullanıcı okuyabilir: 0600). Tüketici okuma adımları:
+//   1. writeIndex'i acquire ile okur, kendi indeksi i < writeIndex olduğu sürece
+//      slot = records[i & (capacity - 1)] kaydının sequence değerini okur,
+//   2. kaydı kopyalar ve sequence'i tekrar okur; iki değer de (i + 1) * 2 ise kayıt geçerlidir,
+//      daha büyükse tüketici geride kalmıştır (üzerine yazılmış) ve ilerlemelidir,
+//   3. yeni kayıt yoksa wakeCounter üzerinde FUTEX_WAIT ile bekler,
+//   4. her uyanışta closed alanını acquire ile okur; 1 ise eşlemeyi bırakır ve halkayı adıyla
+//      yeniden açmayı dener (uygulama yeniden başladığında yeni bir nesne oluşturulur).
+//
+// Paylaşımlı belleği eşleyemeyen tüketiciler (veya Unix dışı sistemler) için aynı kayıtlar
+// QLocalServer üzerinden (Unix soketi / Windows named pipe) ardışık 128 baytlık bloklar halinde gönderilir.
+//
+// Aynı adla çalışan başka bir örnek varsa (soketine bağlanılabiliyorsa) halka ve soket devralınmaz;
+// yalnızca sahibi ölmüş (bayat) nesneler temizlenir.
+class CardEventPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum EventKind : quint8 {
+        CardPoll = 1,
+        MifareAuth = 2,
+        MifareBlockRead = 3
+    };
+
+    explicit CardEventPublisher(QObject *parent = nullptr);
+    ~CardEventPublisher() override;
+
+    // Paylaşımlı bellek halkasını ve yerel soket sunucusunu başlatır; en az biri açılabilirse true döner
+    bool start(const QString &name = QStringLiteral("cardreader-events"));
+    void stop();
+
+    bool isSharedMemoryActive() const;
+
+    void publishCardEvent(bool success,
+                          const QByteArray &raw,
+                          const QString &type,
+                          const QString &uid,
+                          const QString &sak,
+                          const QString &atq);
+    // Yayın yapmadan, sonraki MIFARE kayıtlarına yazılacak kart UID'sini ayarlar ("-" veya boş: kart yok).
+    // Her sorgu sonucunda, yayınlanmayan boş/tekrarlı yanıtlar dahil çağrılmalıdır.
+    void setCurrentUid(const QString &uid);
+    // MIFARE kayıtlarının uid alanı setCurrentUid ile verilen UID ile doldurulur
+    void publishMifareResult(EventKind kind,
+                             bool success,
+                             int blockNumber,
+                             uchar errorCode,
+                             const QByteArray &data);
+
+signals:
+    // Her yayından sonra, halkaya yazılan kaydın aynısıyla yayılır (olay geçmişi için)
+    void eventPublished(const CardEventRecord &record);
+
+private slots:
+    void handleNewConnection();
+
+private:
+    static bool isOwnerAlive(const QString &name);
+    bool openSharedMemory(const QString &name);
+    void closeSharedMemory();
+    void wakeConsumers();
+    void publish(CardEventRecord &record);
+
+    static const quint32 RingCapacity = 1024;
+
+    QString shmName;
+    int shmFd;
+    void *shmBase;
+    size_t shmSize;
+    CardEventRingHeader *ringHeader;
+    CardEventRecord *ringRecords;
+    quint64 nextIndex;
+    QByteArray currentUid; // Son sorgudaki kartın UID'si (kart yoksa boş); MIFARE kayıtlarına yazılır
+
+    QLocalServer *localServer;
+    QList<QLocalSocket *> clients;
+};
+
+#endif // CARDEVENTPUBLISHER_H
@@ -0,0 +1,286 @@
+#include "cardexportwriter.h"
+
+#include <QSaveFile>
+#include <QDateTime>
+#include <QtEndian>
+#include <QMap>
+
+namespace {
+
+const quint32 ExportMagic = 0x58445243; // "CRDX" (little-endian)
+const quint16 ExportVersion = 2; // 2: kayıtlar değişken uzunluklu ve little-endian
+
+const char *kindName(quint8 kind)
+{
+    switch (kind) {
+    case CardEventPublisher::CardPoll:        return "card_poll";
+    case CardEventPublisher::MifareAuth:      return "mifare_auth";
+    case CardEventPublisher::MifareBlockRead: return "mifare_block_read";
+    default:                                  return "unknown";
+    }
+}
+
+// Kayıttaki sabit boyutlu alanı kopyalamadan hex metne çevirir
+QByteArray hexField(const quint8 *data, int length)
+{
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(data), length).toHex().toUpper();
+}
+
+QByteArray isoTime(qint64 timestampUs)
+{
+    return QDateTime::fromMSecsSinceEpoch(timestampUs / 1000, Qt::UTC).toString(Qt::ISODateWithMs).toLatin1();
+}
+
+} // namespace
+
+CardExportWriter::CardExportWriter(QObject *parent)
+    : QObject(parent)
+    , cancelRequested(0)
+{
+}
+
+void CardExportWriter::cancel()
+{
+    cancelRequested.storeRelease(1);
+}
+
+void CardExportWriter::resetCancel()
+{
+    cancelRequested.storeRelease(0);
+}
+
+void CardExportWriter::exportRecords(const CardEventHistory &history, const QString &filePath, int format)
+{
+    // İş kuyruktayken (veya uygulama kapanırken) iptal edildiyse dosyaya hiç dokunulmaz
+    if (cancelRequested.loadAcquire()) {
+        emit finished(false, "Dışa aktarma iptal edildi.");
+        return;
+    }
+
+    qint64 total = 0;
+    for (const QVector<CardEventRecord> &block : history)
+        total += block.size();
+
+    // QSaveFile, yazım tamamlanana kadar geçici dosya kullanır; iptal veya hata yarım dosya bırakmaz
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit finished(false, "Dosya açılamadı: " + file.errorString());
+        return;
+    }
+
+    if (format == CardDump) {
+        QString error;
+        if (!writeCardDump(file, history, total, error)) {
+            file.cancelWriting();
+            emit finished(false, error);
+            return;
+        }
+        if (!file.commit()) {
+            emit finished(false, "Dosya kaydedilemedi: " + file.errorString());
+            return;
+        }
+        emit progress(total, total);
+        emit finished(true, QString("%1 kayıttan kart dökümü çıkarıldı: %2").arg(total).arg(filePath));
+        return;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(FlushThreshold + 1024);
+
+    if (format == Csv)
+        appendCsvHeader(buffer);
+    else if (format == Binary)
+        appendBinaryHeader(buffer, total);
+
+    emit progress(0, total);
+    qint64 written = 0;
+    for (const QVector<CardEventRecord> &block : history) {
+        for (const CardEventRecord &record : block) {
+            if (format == Csv)
+                appendCsv(buffer, record);
+            else if (format == JsonLines)
+                appendJsonLine(buffer, record);
+            else
+                appendBinary(buffer, record);
+
+            // Tampon eşiği aşınca tek seferde diske yazılır
+            if (buffer.size() >= FlushThreshold) {
+                if (file.write(buffer) != buffer.size()) {
+                    file.cancelWriting();
+                    emit finished(false, "Yazma hatası: " + file.errorString());
+                    return;
+                }
+                buffer.clear();
+            }
+
+            if (++written % ProgressInterval == 0) {
+                if (cancelRequested.loadAcquire()) {
+                    file.cancelWriting();
+                    emit finished(false, "Dışa aktarma iptal edildi.");
+                    return;
+                }
+                emit progress(written, total);
+            }
+        }
+    }
+
+    if (!buffer.isEmpty() && file.write(buffer) != buffer.size()) {
+        file.cancelWriting();
+        emit finished(false, "Yazma hatası: " + file.errorString());
+        return;
+    }
+    if (!file.commit()) {
+        emit finished(false, "Dosya kaydedilemedi: " + file.errorString());
+        return;
+    }
+
+    emit progress(total, total);
+    emit finished(true, QString("%1 kayıt dışa aktarıldı: %2").arg(total).arg(filePath));
+}
+
+bool CardExportWriter::writeCardDump(QIODevice &file, const CardEventHistory &history, qint64 total, QString &error)
+{
+    // Geçmiş UID'ye göre gruplanır; her blok için yalnızca son okunan değer tutulur.
+    // Bellek kart sayısı x en fazla 256 blok ile sınırlıdır, kayıt sayısıyla büyümez.
+    struct CardImage {
+        QByteArray type, sak, atq;
+        qint64 lastSeenUs = 0;
+        QMap<int, QByteArray> blocks;
+    };
+    QMap<QByteArray, CardImage> cards;
+
+    emit progress(0, total);
+    qint64 scanned = 0;
+    for (const QVector<CardEventRecord> &block : history) {
+        for (const CardEventRecord &record : block) {
+            if (record.success && record.uidLength > 0) {
+                CardImage &card = cards[hexField(record.uid, record.uidLength)];
+                card.lastSeenUs = record.timestampUs;
+                if (record.kind == CardEventPublisher::CardPoll) {
+                    card.type = hexField(record.type, record.typeLength);
+                    card.sak = hexField(record.sak, record.sakLength);
+                    card.atq = hexField(record.atq, record.atqLength);
+                } else if (record.kind == CardEventPublisher::MifareBlockRead) {
+                    card.blocks[record.blockNumber] = hexField(record.data, record.dataLength);
+                }
+            }
+
+            if (++scanned % ProgressInterval == 0) {
+                if (cancelRequested.loadAcquire()) {
+                    error = "Dışa aktarma iptal edildi.";
+                    return false;
+                }
+                emit progress(scanned, total);
+            }
+        }
+    }
+
+    QByteArray buffer;
+    buffer.reserve(FlushThreshold + 8 * 1024);
+    for (auto it = cards.constBegin(); it != cards.constEnd(); ++it) {
+        const CardImage &card = it.value();
+        buffer.append("{\"uid\":\"").append(it.key());
+        buffer.append("\",\"type\":\"").append(card.type);
+        buffer.append("\",\"sak\":\"").append(card.sak);
+        buffer.append("\",\"atq\":\"").append(card.atq);
+        buffer.append("\",\"last_seen_utc\":\"").append(isoTime(card.lastSeenUs));
+        buffer.append("\",\"blocks\":{");
+        for (auto blockIt = card.blocks.constBegin(); blockIt != card.blocks.constEnd(); ++blockIt) {
+            if (blockIt != card.blocks.constBegin())
+                buffer.append(',');
+            buffer.append('"').append(QByteArray::number(blockIt.key())).append("\":\"").append(blockIt.value()).append('"');
+        }
+        buffer.append("}}\n");
+
+        if (buffer.size() >= FlushThreshold) {
+            if (file.write(buffer) != buffer.size()) {
+                error = "Yazma hatası: " + file.errorString();
+                return false;
+            }
+            buffer.clear();
+        }
+    }
+
+    if (!buffer.isEmpty() && file.write(buffer) != buffer.size()) {
+        error = "Yazma hatası: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void CardExportWriter::appendCsvHeader(QByteArray &out)
+{
+    out.append("sequence,timestamp_us,time_utc,kind,success,block,error_code,type,uid,sak,atq,data\n");
+}
+
+void CardExportWriter::appendCsv(QByteArray &out, const CardEventRecord &record)
+{
+    // Tüm alanlar sayı veya boşluksuz hex olduğundan tırnaklama gerekmez
+    out.append(QByteArray::number(record.sequence / 2)).append(',');
+    out.append(QByteArray::number(record.timestampUs)).append(',');
+    out.append(isoTime(record.timestampUs)).append(',');
+    out.append(kindName(record.kind)).append(',');
+    out.append(record.success ? '1' : '0').append(',');
+    out.append(QByteArray::number(record.blockNumber)).append(',');
+    out.append(QByteArray::number(record.errorCode)).append(',');
+    out.append(hexField(record.type, record.typeLength)).append(',');
+    out.append(hexField(record.uid, record.uidLength)).append(',');
+    out.append(hexField(record.sak, record.sakLength)).append(',');
+    out.append(hexField(record.atq, record.atqLength)).append(',');
+    out.append(hexField(record.data, record.dataLength)).append('\n');
+}
+
+void CardExportWriter::appendJsonLine(QByteArray &out, const CardEventRecord &record)
+{
+    // Satır başına QJsonDocument oluşturmak yerine doğrudan yazılır; değerlerin hiçbiri kaçış gerektirmez
+    out.append("{\"sequence\":").append(QByteArray::number(record.sequence / 2));
+    out.append(",\"timestamp_us\":").append(QByteArray::number(record.timestampUs));
+    out.append(",\"time_utc\":\"").append(isoTime(record.timestampUs));
+    out.append("\",\"kind\":\"").append(kindName(record.kind));
+    out.append("\",\"success\":").append(record.success ? "true" : "false");
+    out.append(",\"block\":").append(QByteArray::number(record.blockNumber));
+    out.append(",\"error_code\":").append(QByteArray::number(record.errorCode));
+    out.append(",\"type\":\"").append(hexField(record.type, record.typeLength));
+    out.append("\",\"uid\":\"").append(hexField(record.uid, record.uidLength));
+    out.append("\",\"sak\":\"").append(hexField(record.sak, record.sakLength));
+    out.append("\",\"atq\":\"").append(hexField(record.atq, record.atqLength));
+    out.append("\",\"data\":\"").append(hexField(record.data, record.dataLength));
+    out.append("\"}\n");
+}
+
+void CardExportWriter::appendBinaryHeader(QByteArray &out, qint64 count)
+{
+    // 16 baytlık başlık: magic (4), sürüm (2), ayrılmış (2), kayıt sayısı (8); hepsi little-endian
+    uchar header[16];
+    qToLittleEndian<quint32>(ExportMagic, header);
+    qToLittleEndian<quint16>(ExportVersion, header + 4);
+    qToLittleEndian<quint16>(0, header + 6);
+    qToLittleEndian<quint64>(static_cast<quint64>(count), header + 8);
+    out.append(reinterpret_cast<const char *>(header), sizeof(header));
+}
+
+void CardExportWriter::appendBinary(QByteArray &out, const CardEventRecord &record)
+{
+    // Değişken uzunluklu kayıt, little-endian: sıra no (8), zaman us (8), kind, success, block,
+    // error_code, uid/type/sak/atq uzunlukları (8 x 1), data uzunluğu (2), ardından yalnızca
+    // kullanılan uid, type, sak, atq ve data baytları. Paylaşımlı bellekteki 128 baytlık
+    // düzenden farklı olarak boş alanlar ve makine bayt sırası dosyaya yazılmaz.
+    uchar fixed[26];
+    qToLittleEndian<quint64>(record.sequence / 2, fixed);
+    qToLittleEndian<qint64>(record.timestampUs, fixed + 8);
+    fixed[16] = record.kind;
+    fixed[17] = record.success;
+    fixed[18] = record.blockNumber;
+    fixed[19] = record.errorCode;
+    fixed[20] = record.uidLength;
+    fixed[21] = record.typeLength;
+    fixed[22] = record.sakLength;
+    fixed[23] = record.atqLength;
+    qToLittleEndian<quint16>(record.dataLength, fixed + 24);
+    out.append(reinterpret_cast<const char *>(fixed), sizeof(fixed));
+    out.append(reinterpret_cast<const char *>(record.uid), record.uidLength);
+    out.append(reinterpret_cast<const char *>(record.type), record.typeLength);
+    out.append(reinterpret_cast<const char *>(record.sak), record.sakLength);
+    out.append(reinterpret_cast<const char *>(record.atq), record.atqLength);
+    out.append(reinterpret_cast<const char *>(record.data), record.dataLength);
+}
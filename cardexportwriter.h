@@ -0,0 +1,62 @@
+#ifndef CARDEXPORTWRITER_H
+#define CARDEXPORTWRITER_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QAtomicInt>
+#include <QIODevice>
+
+#include "cardeventpublisher.h"
+
+// Olay geçmişi sabit boyutlu bloklar halinde tutulur. Dışa aktarmaya verilen anlık görüntü
+// yalnızca blokları paylaşır; arayüz yeni kayıtları her zaman paylaşılmayan yeni bir bloğa ekler.
+typedef QList<QVector<CardEventRecord>> CardEventHistory;
+
+// Olay geçmişini ve kart dökümlerini dosyaya aktaran yazıcı.
+// Ayrı bir QThread üzerinde çalışır; kayıtları sabit boyutlu bir tamponda biçimlendirip
+// parça parça diske yazar, böylece bellek kullanımı kayıt sayısından bağımsız kalır.
+class CardExportWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        Csv = 0,
+        JsonLines = 1,
+        Binary = 2,
+        CardDump = 3  // UID başına bir JSON satırı: kart bilgileri ve okunan blokların son değerleri
+    };
+
+    explicit CardExportWriter(QObject *parent = nullptr);
+
+    // Herhangi bir iş parçacığından çağrılabilir; yazım bir sonraki parti sonunda durur
+    void cancel();
+    // Yeni bir dışa aktarma istenmeden önce arayüz iş parçacığında çağrılır.
+    // Yazıcı bayrağı kendisi sıfırlamaz; böylece kuyruktaki iş başlamadan gelen iptal kaybolmaz.
+    void resetCancel();
+
+public slots:
+    void exportRecords(const CardEventHistory &history, const QString &filePath, int format);
+
+signals:
+    void progress(qint64 written, qint64 total);
+    void finished(bool success, const QString &message);
+
+private:
+    bool writeCardDump(QIODevice &file, const CardEventHistory &history, qint64 total, QString &error);
+
+    static void appendCsvHeader(QByteArray &out);
+    static void appendCsv(QByteArray &out, const CardEventRecord &record);
+    static void appendJsonLine(QByteArray &out, const CardEventRecord &record);
+    static void appendBinaryHeader(QByteArray &out, qint64 count);
+    static void appendBinary(QByteArray &out, const CardEventRecord &record);
+
+    static const int FlushThreshold = 64 * 1024; // Diske yazmadan önce biriktirilen bayt
+    static const int ProgressInterval = 1024;    // Kaç kayıtta bir ilerleme bildirilir
+
+    QAtomicInt cancelRequested;
+};
+
+#endif // CARDEXPORTWRITER_H
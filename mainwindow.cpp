@@ -1,9 +1,12 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "detailsdialog.h" // detailsdialog.h dosyasının buraya dahil edildiğinden emin olun
+#include "cardeventpublisher.h"
 
 #include <QSerialPortInfo>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QDateTime>
 #include <QDebug>
 #include <QByteArray>
 
@@ -11,6 +14,10 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , detailsDialog(new DetailsDialog(this)) // DetailsDialog artık tanınıyor
+    , eventPublisher(new CardEventPublisher(this))
+    , exportWriter(new CardExportWriter) // Ebeveynsiz; exportThread'e taşınır
+    , historySize(0)
+    , exportRunning(false)
 {
     ui->setupUi(this); // UI elemanlarını ayarlar
     ui->statusLabel->setText("Port kapalı"); // Başlangıç durumu
@@ -35,6 +42,26 @@ MainWindow::MainWindow(QWidget *parent)
     ui->keyNumberInput->setText("0"); // Varsayılan key #0
     ui->sectorNumberInput->setText("0"); // Varsayılan sektör #0
     ui->authStatusLabel->setText("Kimlik doğrulama bekleniyor.");
+
+    // Paylaşımlı bellek halkası / yerel soket üzerinden olay yayınını başlatır
+    if (!eventPublisher->start())
+        qDebug() << "Olay yayını başlatılamadı, kart olayları yalnızca arayüzde gösterilecek.";
+    connect(eventPublisher, &CardEventPublisher::eventPublished, this, &MainWindow::appendHistory);
+
+    // Dışa aktarma yazıcısı ayrı iş parçacığında çalışır; sorgulama ve arayüz beklemez
+    qRegisterMetaType<CardEventHistory>("CardEventHistory");
+    exportWriter->moveToThread(&exportThread);
+    connect(&exportThread, &QThread::finished, exportWriter, &QObject::deleteLater);
+    connect(this, &MainWindow::exportRequested, exportWriter, &CardExportWriter::exportRecords);
+    connect(exportWriter, &CardExportWriter::progress, this, &MainWindow::handleExportProgress);
+    connect(exportWriter, &CardExportWriter::finished, this, &MainWindow::handleExportFinished);
+    exportThread.start();
+
+    ui->exportFormatCombo->addItem("CSV", CardExportWriter::Csv);
+    ui->exportFormatCombo->addItem("JSON Lines", CardExportWriter::JsonLines);
+    ui->exportFormatCombo->addItem("İkili (kompakt)", CardExportWriter::Binary);
+    ui->exportFormatCombo->addItem("Kart Dökümü (UID başına JSON)", CardExportWriter::CardDump);
+    ui->exportProgressBar->setRange(0, 100);
 }
 
 MainWindow::~MainWindow()
@@ -42,6 +69,11 @@ MainWindow::~MainWindow()
     // Uygulama kapanırken zamanlayıcıyı durdurur ve seri portu kapatır
     pollTimer.stop();
     serial.close();
+
+    // Süren dışa aktarma varsa iptal edilir ve yazıcı iş parçacığının bitmesi beklenir
+    exportWriter->cancel();
+    exportThread.quit();
+    exportThread.wait();
     delete ui;
 }
 
@@ -93,6 +125,7 @@ void MainWindow::on_openButton_clicked()
         qDebug() << "Port kapatılıyor";
         pollTimer.stop(); // Kart sorgulama zamanlayıcısını durdurur
         serial.close(); // Seri portu kapatır
+        eventPublisher->setCurrentUid(QString()); // Kart takibi durdu, UID artık güncel değil
         ui->openButton->setText("Portu Aç"); // UI'yı günceller
         ui->statusLabel->setText("Port kapalı");
         qDebug() << "Port kapatıldı ve polling durduruldu.";
@@ -179,6 +212,23 @@ void MainWindow::on_cardDetected(bool success,
     // Detay penceresini ve ana penceredeki ham veri metin alanını günceller
     detailsDialog->setDetails(raw, type, uid, sak, atq);
     ui->detailsText->appendPlainText(raw.toHex(' ').toUpper() + "\n"); // Ham veriyi ekler ve yeni satıra geçer
+
+    // Sonraki MIFARE sonuçlarının hangi karta ait olduğu her sorguda (yayınlanmasa da) güncellenir;
+    // okuyucu yanıt vermediyse veya kart yoksa UID temizlenir, önceki kartın UID'si kullanılmaz
+    eventPublisher->setCurrentUid(success ? uid : QString());
+
+    // Olayı diğer yerel süreçlere yayınlar. Okuyucu hiç yanıt vermediyse ya da kart yokken
+    // aynı hata yanıtı tekrar geldiyse yayın yapılmaz; abonelere her 2 saniyede boş olay gitmez.
+    if (raw.isEmpty())
+        return;
+    if (success) {
+        lastFailedPoll.clear();
+    } else {
+        if (raw == lastFailedPoll)
+            return;
+        lastFailedPoll = raw;
+    }
+    eventPublisher->publishCardEvent(success, raw, type, uid, sak, atq);
 }
 
 void MainWindow::on_detailsButton_clicked()
@@ -187,6 +237,90 @@ void MainWindow::on_detailsButton_clicked()
     detailsDialog->show();
 }
 
+void MainWindow::appendHistory(const CardEventRecord &record)
+{
+    // Kayıtlar son bloğa eklenir; blok dolduysa yeni blok açılır. Sınır aşılınca en eski blok
+    // bütün olarak atılır, kayıtlar kaydırılmaz veya kopyalanmaz.
+    if (eventHistory.isEmpty() || eventHistory.constLast().size() >= HistoryBlockSize)
+        eventHistory.append(QVector<CardEventRecord>());
+    eventHistory.last().append(record);
+    ++historySize;
+
+    while (historySize > MaxHistoryRecords || eventHistory.size() > MaxHistoryBlocks) {
+        historySize -= eventHistory.constFirst().size();
+        eventHistory.removeFirst();
+    }
+}
+
+void MainWindow::on_exportButton_clicked()
+{
+    // Dışa aktarma sürüyorsa buton iptal işlevi görür
+    if (exportRunning) {
+        exportWriter->cancel();
+        ui->exportStatusLabel->setText("İptal ediliyor...");
+        return;
+    }
+
+    if (historySize == 0) {
+        QMessageBox::information(this, "Bilgi", "Dışa aktarılacak kayıt yok.");
+        return;
+    }
+
+    int format = ui->exportFormatCombo->currentData().toInt();
+    QString suffix, filter;
+    if (format == CardExportWriter::Csv) {
+        suffix = "csv";
+        filter = "CSV (*.csv)";
+    } else if (format == CardExportWriter::JsonLines) {
+        suffix = "jsonl";
+        filter = "JSON Lines (*.jsonl)";
+    } else if (format == CardExportWriter::Binary) {
+        suffix = "crdx";
+        filter = "İkili Kayıt (*.crdx)";
+    } else {
+        suffix = "jsonl";
+        filter = "Kart Dökümü (*.jsonl)";
+    }
+
+    QString defaultName = QString("kart_gecmisi_%1.%2")
+                              .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+                              .arg(suffix);
+    QString filePath = QFileDialog::getSaveFileName(this, "Dışa Aktar", defaultName, filter);
+    if (filePath.isEmpty())
+        return;
+
+    exportRunning = true;
+    ui->exportButton->setText("İptal");
+    ui->exportProgressBar->setValue(0);
+    ui->exportStatusLabel->setText(QString("%1 kayıt dışa aktarılıyor...").arg(historySize));
+
+    // Yazıcıya blokları paylaşan bir anlık görüntü verilir. Son blok boş değilse ardından yeni,
+    // boş bir blok açılır; böylece yazım sürerken gelen olaylar paylaşılan bloklara eklenmez ve
+    // onları kopyalatmaz. Boş blok önceden ayrılmaz, yalnızca gelen kayıtlar kadar büyür.
+    CardEventHistory snapshot = eventHistory;
+    if (!eventHistory.constLast().isEmpty())
+        eventHistory.append(QVector<CardEventRecord>());
+
+    // İptal bayrağı burada, iş kuyruğa girmeden sıfırlanır; kuyruktayken basılan "İptal" kaybolmaz
+    exportWriter->resetCancel();
+    emit exportRequested(snapshot, filePath, format);
+}
+
+void MainWindow::handleExportProgress(qint64 written, qint64 total)
+{
+    ui->exportProgressBar->setValue(total > 0 ? static_cast<int>(written * 100 / total) : 100);
+}
+
+void MainWindow::handleExportFinished(bool success, const QString &message)
+{
+    exportRunning = false;
+    ui->exportButton->setText("Dışa Aktar");
+    ui->exportStatusLabel->setText(message);
+    if (!success)
+        ui->exportProgressBar->setValue(0);
+    qDebug() << "Dışa aktarma sonucu:" << success << message;
+}
+
 // LRC (Longitudinal Redundancy Check) hesaplama fonksiyonu
 // Protokol belgesine göre, LRC paketin STX dışındaki tüm baytlarının XOR'udur.
 uchar MainWindow::calculateLRC(const QByteArray &data)
@@ -258,7 +392,7 @@ void MainWindow::on_readBlockButton_clicked()
     }
 
     qDebug() << "MIFARE READ BLOCK Yanıtı Alındı:" << resp.toHex(' ').toUpper();
-    processMifareResponse(resp); // Yanıtı işleme fonksiyonunu çağırır
+    processMifareResponse(resp, blockNumber); // Yanıtı işleme fonksiyonunu çağırır
 }
 
 
@@ -435,6 +569,7 @@ void MainWindow::on_authenticateButton_clicked()
 
         if (templateTag2 == 0x01) { // Başarılı Kimlik Doğrulama
             ui->authStatusLabel->setText("Kimlik doğrulama başarılı!");
+            eventPublisher->publishMifareResult(CardEventPublisher::MifareAuth, true, sectorNumber, 0, QByteArray());
             qDebug() << "Kimlik doğrulama başarılı.";
         } else if (templateTag2 == 0x03) { // Hata Yanıtı
             QByteArray errorDataPart = authResp.mid(8);
@@ -454,6 +589,7 @@ void MainWindow::on_authenticateButton_clicked()
                                                  .arg(QString::number(errorCode, 16).toUpper())
                                                  .arg(QString(authResp.toHex(' ').toUpper())));
                 qDebug() << "Kimlik doğrulama hatası. Kod:" << QString::number(errorCode, 16).toUpper();
+                eventPublisher->publishMifareResult(CardEventPublisher::MifareAuth, false, sectorNumber, errorCode, QByteArray());
             } else {
                 ui->authStatusLabel->setText("Kimlik doğrulama başarısız: Hata yanıtı ayrıştırılamadı.");
             }
@@ -468,7 +604,7 @@ void MainWindow::on_authenticateButton_clicked()
 // ... (diğer kodlar) ...
 
 // MIFARE komut yanıtlarını işleme fonksiyonu (Blok Okuma için)
-void MainWindow::processMifareResponse(const QByteArray &resp)
+void MainWindow::processMifareResponse(const QByteArray &resp, int blockNumber)
 {
     if (resp.isEmpty()) {
         ui->blockDataDisplay->setPlainText("Boş yanıt alındı.");
@@ -523,6 +659,7 @@ void MainWindow::processMifareResponse(const QByteArray &resp)
                                 QByteArray blockData = mifareData.mid(1);
                                 ui->blockDataDisplay->setPlainText("Okunan Blok Verisi:\n" + blockData.toHex(' ').toUpper());
                                 ui->statusLabel->setText("MIFARE Blok okuma başarılı.");
+                                eventPublisher->publishMifareResult(CardEventPublisher::MifareBlockRead, true, blockNumber, 0, blockData);
                             } else {
                                 ui->blockDataDisplay->setPlainText("Yanıt eksik MIFARE blok verisi. Mifare Data: " + mifareData.toHex(' ').toUpper());
                             }
@@ -551,6 +688,7 @@ void MainWindow::processMifareResponse(const QByteArray &resp)
                                                            .arg(QString::number(errorCode, 16).toUpper())
                                                            .arg(QString(resp.toHex(' ').toUpper())));
                     ui->statusLabel->setText("MIFARE Blok okunamadı (Hata).");
+                    eventPublisher->publishMifareResult(CardEventPublisher::MifareBlockRead, false, blockNumber, errorCode, QByteArray());
                 } else {
                     ui->blockDataDisplay->setPlainText("MIFARE Blok okuma hatası (Hata yanıtı ayrıştırılamadı). Yanıt: " + resp.toHex(' ').toUpper());
                     ui->statusLabel->setText("MIFARE Blok okunamadı (Hata).");
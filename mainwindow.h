@@ -5,6 +5,10 @@
 #include <QSerialPort>
 #include <QTimer>
 #include <QByteArray> // QByteArray sınıfı için gerekli
+#include <QThread>
+#include <QVector>
+
+#include "cardexportwriter.h" // Olay geçmişi (CardEventHistory) için
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -20,6 +24,10 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow() override;
 
+signals:
+    // Dışa aktarma işini arka plandaki yazıcı iş parçacığına iletir
+    void exportRequested(const CardEventHistory &history, const QString &filePath, int format);
+
 private slots:
     void on_refreshButton_clicked();
     void on_openButton_clicked();
@@ -37,6 +45,10 @@ private slots:
     // Yeni eklenen kimlik doğrulama butonu için slot
     void on_authenticateButton_clicked();
 
+    // Olay geçmişini dışa aktarma butonu ve yazıcıdan gelen bildirimler
+    void on_exportButton_clicked();
+    void handleExportProgress(qint64 written, qint64 total);
+    void handleExportFinished(bool success, const QString &message);
 
 private:
     void refreshPorts();
@@ -48,15 +60,32 @@ private:
                        QString &atq);
 
     // MIFARE yanıtlarını işlemek için yardımcı fonksiyon
-    void processMifareResponse(const QByteArray &resp);
+    void processMifareResponse(const QByteArray &resp, int blockNumber);
 
     // Longitudinal Redundancy Check (LRC) hesaplama fonksiyonu
     uchar calculateLRC(const QByteArray &data);
 
+    // Yayınlanan her olayı sınırlı boyuttaki geçmişe ekler
+    void appendHistory(const CardEventRecord &record);
+
+    // Geçmiş hem kayıt hem blok sayısıyla sınırlıdır. Bloklar önceden ayrılmaz, QVector ile
+    // büyür (kapasite en fazla kayıtların ~2 katı); toplam bellek en fazla ~25.6 MB olur.
+    static const int MaxHistoryRecords = 100000;
+    static const int HistoryBlockSize = 4096; // Tam dolu bir blok 512 KB
+    static const int MaxHistoryBlocks = 64;   // Dışa aktarmalarla kapatılan yarım bloklar dahil
+
     Ui::MainWindow *ui;
     QSerialPort serial;
     QTimer pollTimer;
     DetailsDialog *detailsDialog; // Pointer olarak tanımlandığında sorun yok
+    CardEventPublisher *eventPublisher; // Kart olaylarını diğer yerel süreçlere yayınlar
+    QByteArray lastFailedPoll; // Son yayınlanan başarısız sorgu yanıtı (tekrarları yayınlamamak için)
+
+    CardEventHistory eventHistory; // Dışa aktarma için kart olayları ve MIFARE sonuçları (bloklar halinde)
+    int historySize; // eventHistory'deki toplam kayıt sayısı
+    QThread exportThread;
+    CardExportWriter *exportWriter; // exportThread üzerinde çalışır
+    bool exportRunning;
 };
 
 #endif // MAINWINDOW_H